@@ -698,6 +698,24 @@ CONF_String(es_scroll_keepalive, "5m");
 // HTTP connection timeout for es.
 CONF_Int32(es_http_timeout_ms, "5000");
 
+// Ask es for gzip/deflate-compressed scroll responses. Requires
+// http.compression enabled on the es side to take effect; decompression
+// is handled transparently by libcurl.
+CONF_Bool(es_enable_http_compression, "true");
+
+// Scroll page size used when the caller does not pass a positive batch_size.
+CONF_Int32(es_scroll_default_batch_size, "4096");
+
+// The number of threads serving es scan http io (scroll prefetch and
+// scroll-context cleanup), vCPUs by default. These tasks block on the network,
+// so they get their own small pool instead of competing with pipeline sink io.
+CONF_Int64(es_io_thread_pool_thread_num, "0");
+CONF_Int64(es_io_thread_pool_queue_size, "4096");
+
+// How long to collect scroll ids from readers closing around the same time
+// before clearing them with one DELETE _search/scroll request per es cluster.
+CONF_mInt32(es_clear_scroll_batch_window_ms, "20");
+
 // es index max result window, and this value affects batch size.
 // if request batch size exceeds this value, ES will return bad request(400)
 // https://www.elastic.co/guide/en/elasticsearch/reference/current/index-modules.html
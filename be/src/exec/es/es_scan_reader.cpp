@@ -34,10 +34,19 @@
 
 #include "exec/es/es_scan_reader.h"
 
+#include <algorithm>
+#include <chrono>
+#include <initializer_list>
 #include <map>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <vector>
 
+#include "common/compiler_util.h"
 #include "common/config.h"
 #include "common/logging.h"
 #include "common/status.h"
@@ -65,58 +74,117 @@ ESScanReader::ESScanReader(const std::string& target, const std::map<std::string
           _http_timeout_ms(config::es_http_timeout_ms),
           _doc_value_mode(doc_value_mode) {
     _target = target;
-    _index = props.at(KEY_INDEX);
-    if (props.find(KEY_TYPE) != props.end()) {
-        _type = props.at(KEY_TYPE);
-    }
-    if (props.find(KEY_USER_NAME) != props.end()) {
-        _user_name = props.at(KEY_USER_NAME);
-    }
-    if (props.find(KEY_PASS_WORD) != props.end()) {
-        _passwd = props.at(KEY_PASS_WORD);
-    }
-    if (props.find(KEY_SHARD) != props.end()) {
-        _shards = props.at(KEY_SHARD);
-    }
-    if (props.find(KEY_QUERY) != props.end()) {
-        _query = props.at(KEY_QUERY);
+    // one pass over the properties instead of one tree lookup per optional key
+    const std::string* terminate_after = nullptr;
+    for (const auto& [key, value] : props) {
+        if (key == KEY_INDEX) {
+            _index = value;
+        } else if (key == KEY_TYPE) {
+            _type = value;
+        } else if (key == KEY_USER_NAME) {
+            _user_name = value;
+        } else if (key == KEY_PASS_WORD) {
+            _passwd = value;
+        } else if (key == KEY_SHARD) {
+            _shards = value;
+        } else if (key == KEY_QUERY) {
+            _query = value;
+        } else if (key == KEY_ES_NET_SSL) {
+            std::istringstream(value) >> std::boolalpha >> _ssl_enabled;
+        } else if (key == KEY_BATCH_SIZE) {
+            _batch_size = atoi(value.c_str());
+        } else if (key == KEY_TERMINATE_AFTER) {
+            terminate_after = &value;
+        }
     }
-
-    if (props.find(KEY_ES_NET_SSL) != props.end()) {
-        std::istringstream(props.at(KEY_ES_NET_SSL)) >> std::boolalpha >> _ssl_enabled;
+    // the scroll page size is fixed when the search context is created, so it
+    // has to be sane up front: fall back to the configured default when unset
+    // and cap it at index.max_result_window, beyond which es rejects the
+    // request with a 400
+    if (_batch_size <= 0) {
+        _batch_size = config::es_scroll_default_batch_size;
     }
-
-    std::string batch_size_str = props.at(KEY_BATCH_SIZE);
-    _batch_size = atoi(batch_size_str.c_str());
+    _batch_size = std::min(_batch_size, config::es_index_max_result_window);
     std::string filter_path = _doc_value_mode ? DOCVALUE_SCROLL_SEARCH_FILTER_PATH : SOURCE_SCROLL_SEARCH_FILTER_PATH;
 
-    if (props.find(KEY_TERMINATE_AFTER) != props.end()) {
+    // URLs are assembled from known parts, reserve the final size once and append
+    // instead of going through the formatting machinery
+    auto build_url = [](std::initializer_list<std::string_view> parts) {
+        size_t total = 0;
+        for (const auto& part : parts) {
+            total += part.size();
+        }
+        std::string url;
+        url.reserve(total);
+        for (const auto& part : parts) {
+            url.append(part);
+        }
+        return url;
+    };
+
+    if (terminate_after != nullptr) {
         _exactly_once = true;
         // just send a normal search against the elasticsearch with additional terminate_after param to achieve terminate early effect when limit take effect
         if (_type.empty()) {
-            _search_url = fmt::format("{}/{}/_search?terminate_after={}&preference=_shards:{}&{}", _target, _index,
-                                      props.at(KEY_TERMINATE_AFTER), _shards, filter_path);
+            _search_url = build_url({_target, "/", _index, "/_search?terminate_after=", *terminate_after,
+                                     "&preference=_shards:", _shards, "&", filter_path});
         } else {
-            _search_url = fmt::format("{}/{}/{}/_search?terminate_after={}&preference=_shards:{}&{}", _target, _index,
-                                      _type, props.at(KEY_TERMINATE_AFTER), _shards, filter_path);
+            _search_url = build_url({_target, "/", _index, "/", _type, "/_search?terminate_after=", *terminate_after,
+                                     "&preference=_shards:", _shards, "&", filter_path});
         }
     } else {
         _exactly_once = false;
         // scroll request for scanning
         // add terminate_after for the first scroll to avoid decompress all postings list
         if (_type.empty()) {
-            _init_scroll_url = fmt::format("{}/{}/_search?scroll={}&preference=_shards:{}&{}", _target, _index,
-                                           _scroll_keep_alive, _shards, filter_path);
+            _init_scroll_url = build_url({_target, "/", _index, "/_search?scroll=", _scroll_keep_alive,
+                                          "&preference=_shards:", _shards, "&", filter_path});
         } else {
-            _init_scroll_url = fmt::format("{}/{}/{}/_search?scroll={}&preference=_shards:{}&{}", _target, _index,
-                                           _type, _scroll_keep_alive, _shards, filter_path);
+            _init_scroll_url = build_url({_target, "/", _index, "/", _type, "/_search?scroll=", _scroll_keep_alive,
+                                          "&preference=_shards:", _shards, "&", filter_path});
         }
-        _next_scroll_url = _target + REQUEST_SEARCH_SCROLL_PATH + "?" + filter_path;
+        _next_scroll_url = build_url({_target, REQUEST_SEARCH_SCROLL_PATH, "?", filter_path});
+        // the body of every subsequent scroll request only differs in the scroll
+        // id, cache the invariant prefix; scroll ids are url-safe base64, so no
+        // json escaping is ever needed
+        _next_scroll_body_prefix = build_url({R"({"scroll":")", _scroll_keep_alive, R"(","scroll_id":")"});
     }
     _eos = false;
 }
 
-ESScanReader::~ESScanReader() = default;
+ESScanReader::~ESScanReader() {
+    _drain_prefetch();
+}
+
+std::string ESScanReader::_build_next_scroll_body() const {
+    std::string body;
+    body.reserve(_next_scroll_body_prefix.size() + _scroll_id.size() + 2);
+    body.append(_next_scroll_body_prefix);
+    body.append(_scroll_id);
+    body.append("\"}");
+    return body;
+}
+
+void ESScanReader::_launch_next_scroll() {
+    DCHECK(!_prefetch_future.valid());
+    auto task = std::make_shared<std::packaged_task<Status()>>(
+            [this, body = _build_next_scroll_body()]() {
+                _prefetch_response.clear();
+                return _network_client.execute_post_request(body, &_prefetch_response);
+            });
+    auto* thread_pool = ExecEnv::GetInstance()->es_io_pool();
+    std::future<Status> future = task->get_future();
+    if (thread_pool->try_offer([task]() { (*task)(); })) {
+        _prefetch_future = std::move(future);
+    }
+}
+
+void ESScanReader::_drain_prefetch() {
+    if (_prefetch_future.valid()) {
+        (void)_prefetch_future.get();
+        _prefetch_future = std::future<Status>();
+    }
+}
 
 Status ESScanReader::open() {
     _is_first = true;
@@ -127,21 +195,33 @@ Status ESScanReader::open() {
         RETURN_IF_ERROR(_network_client.init(_init_scroll_url));
         LOG(INFO) << "First scroll request URL: " << _init_scroll_url;
     }
+    // readers fanning out to the same cluster (slices, shards) pool their dns
+    // results, tls sessions and idle connections through the shared curl cache
+    _network_client.use_shared_connection_cache();
     if (!_user_name.empty() || !_passwd.empty()) {
         _network_client.set_basic_auth(_user_name, _passwd);
     }
     _network_client.set_content_type("application/json");
+    // the client is reused for all scroll requests of this reader, keep the
+    // connection alive so that only the first request pays the TCP/TLS handshake
+    _network_client.set_header("Connection", "keep-alive");
+    _network_client.set_keep_alive();
+    if (config::es_enable_http_compression) {
+        // scroll responses are highly repetitive json, compression typically cuts
+        // the transferred bytes by 5-10x for wide _source documents
+        _network_client.set_accept_encoding("gzip,deflate");
+    }
+    _network_client.set_timeout_ms(_http_timeout_ms);
     if (_ssl_enabled) {
         _network_client.trust_all_ssl();
+        // the connection normally stays alive across pages; should es drop it,
+        // a resumed TLS session keeps the reconnect to a single round-trip
+        _network_client.enable_ssl_session_cache();
     }
-    // phase open, we cached the first response for `get_next` phase
-    Status status = _network_client.execute_post_request(_query, &_cached_response);
+    // the first search request is deferred to the first get_next call: a scan
+    // that is cancelled before the consumer ever asks for data then never pays
+    // for fetching (and holding) a full batch
     VLOG(2) << "ES Query:" << _query;
-    if (!status.ok() || _network_client.get_http_status() != 200) {
-        std::string err_msg = fmt::format("Failed to connect to ES server, errmsg is: {}", status.message());
-        return Status::InternalError(err_msg);
-    }
-    VLOG(2) << "open _cached response: " << _cached_response;
     return Status::OK();
 }
 
@@ -155,42 +235,56 @@ Status ESScanReader::get_next(bool* scan_eos, std::unique_ptr<T>& scroll_parser)
     }
 
     if (_is_first) {
-        response = _cached_response;
+        // issue the initial search request the client was prepared for in open()
+        Status status = _network_client.execute_post_request(_query, &response);
+        if (UNLIKELY(!status.ok() || _network_client.get_http_status() != 200)) {
+            std::string err_msg = fmt::format("Failed to connect to ES server, errmsg is: {}", status.message());
+            return Status::InternalError(err_msg);
+        }
+        if (!_exactly_once) {
+            // every subsequent request hits the same scroll endpoint, switch the URL once
+            // here instead of re-initializing (and reconnecting) the client per page
+            RETURN_IF_ERROR(_network_client.set_url(_next_scroll_url));
+        }
         _is_first = false;
     } else {
         if (_exactly_once) {
             return Status::OK();
         }
-        RETURN_IF_ERROR(_network_client.init(_next_scroll_url));
-        if (!_user_name.empty() || !_passwd.empty()) {
-            _network_client.set_basic_auth(_user_name, _passwd);
-        }
-        _network_client.set_content_type("application/json");
-        _network_client.set_timeout_ms(_http_timeout_ms);
-        if (_ssl_enabled) {
-            _network_client.trust_all_ssl();
+        if (_prefetch_future.valid()) {
+            // the request for this page was already issued while the previous batch
+            // was being consumed, just wait for the bytes
+            Status status = _prefetch_future.get();
+            _prefetch_future = std::future<Status>();
+            RETURN_IF_ERROR(status);
+            response = std::move(_prefetch_response);
+        } else {
+            // the client was fully configured in open() and keeps its connection
+            // alive, just issue the next scroll request on it
+            RETURN_IF_ERROR(_network_client.execute_post_request(_build_next_scroll_body(), &response));
         }
-        RETURN_IF_ERROR(_network_client.execute_post_request(
-                ESScrollQueryBuilder::build_next_scroll_body(_scroll_id, _scroll_keep_alive), &response));
         long status = _network_client.get_http_status();
-        if (status == 404) {
+        if (UNLIKELY(status == 404)) {
             LOG(WARNING) << "request scroll search failure 404["
                          << ", response: " << (response.empty() ? "empty response" : response);
             return Status::InternalError("No search context found for " + _scroll_id);
         }
-        if (status != 200) {
+        if (UNLIKELY(status != 200)) {
+            const std::string& err_response = response.empty() ? "empty response" : response;
             LOG(WARNING) << "request scroll search failure["
-                         << "http status" << status
-                         << ", response: " << (response.empty() ? "empty response" : response);
-            return Status::InternalError("request scroll search failure: " +
-                                         (response.empty() ? "empty response" : response));
+                         << "http status" << status << ", response: " << err_response;
+            return Status::InternalError("request scroll search failure: " + err_response);
         }
     }
 
-    scroll_parser.reset(new T(_doc_value_mode));
+    // reuse the parser (and the capacity of its internal buffers) across
+    // pages instead of re-allocating it for every batch
+    if (scroll_parser == nullptr) {
+        scroll_parser.reset(new T(_doc_value_mode));
+    }
     VLOG(2) << "get_next request ES, returned response: " << response;
-    Status status = scroll_parser->parse(response, _exactly_once);
-    if (!status.ok()) {
+    Status status = scroll_parser->parse(std::move(response), _exactly_once);
+    if (UNLIKELY(!status.ok())) {
         _eos = true;
         LOG(WARNING) << status.message();
         return status;
@@ -207,6 +301,10 @@ Status ESScanReader::get_next(bool* scan_eos, std::unique_ptr<T>& scroll_parser)
         }
 
         _eos = scroll_parser->get_size() < _batch_size;
+        if (!_eos) {
+            // overlap fetching the next page with the consumption of this batch
+            _launch_next_scroll();
+        }
     }
     *scan_eos = false;
     return Status::OK();
@@ -214,16 +312,39 @@ Status ESScanReader::get_next(bool* scan_eos, std::unique_ptr<T>& scroll_parser)
 
 template Status ESScanReader::get_next<ScrollParser>(bool* scan_eos, std::unique_ptr<ScrollParser>& scroll_parser);
 
-Status ESScanReader::close() {
-    if (_scroll_id.empty()) {
-        return Status::OK();
-    }
+namespace {
 
-    std::string scratch_target = _target + REQUEST_SEARCH_SCROLL_PATH;
-    std::function<void()> send_del_request = [user_name = _user_name, passwd = _passwd, enable_ssl = _ssl_enabled,
-                                              scroll_id = _scroll_id, scratch_target]() {
+// scroll contexts of readers closing around the same time are batched per
+// (endpoint, credentials), so a wide sliced-scroll fan-out is torn down with
+// one DELETE _search/scroll per es cluster instead of one request per reader
+struct ScrollReaper {
+    // endpoint url plus the credentials needed to talk to it
+    using Key = std::tuple<std::string, std::string, std::string, bool>;
+
+    std::mutex mutex;
+    std::map<Key, std::vector<std::string>> pending;
+    bool flush_scheduled = false;
+};
+
+ScrollReaper& scroll_reaper() {
+    static ScrollReaper s_reaper;
+    return s_reaper;
+}
+
+void flush_scroll_reaper() {
+    auto& reaper = scroll_reaper();
+    std::map<ScrollReaper::Key, std::vector<std::string>> pending;
+    {
+        std::lock_guard<std::mutex> l(reaper.mutex);
+        pending.swap(reaper.pending);
+        reaper.flush_scheduled = false;
+    }
+    for (const auto& [key, scroll_ids] : pending) {
+        const auto& [target, user_name, passwd, enable_ssl] = key;
         HttpClient client;
-        RETURN_IF(!client.init(scratch_target).ok(), (void)0);
+        if (!client.init(target).ok()) {
+            continue;
+        }
         if (!user_name.empty() || !passwd.empty()) {
             client.set_basic_auth(user_name, passwd);
         }
@@ -234,19 +355,49 @@ Status ESScanReader::close() {
             client.trust_all_ssl();
         }
         std::string response;
-        auto payload = ESScrollQueryBuilder::build_clear_scroll_body(scroll_id);
+        auto payload = ESScrollQueryBuilder::build_clear_scroll_body(scroll_ids);
         auto st = client.execute_delete_request(payload, &response);
         if (!st.ok()) {
             LOG(WARNING) << "es delete scroll id failed:" << st.to_string();
-            return;
+            continue;
         }
         if (client.get_http_status() != 200) {
             LOG(WARNING) << "es_scan_reader delete scroll context failure status code:" << client.get_http_status();
         }
-    };
-    auto* thread_pool = ExecEnv::GetInstance()->pipeline_sink_io_pool();
-    if (!thread_pool->try_offer(send_del_request)) {
-        LOG(WARNING) << "try to delete scroll id failed";
+    }
+}
+
+} // namespace
+
+Status ESScanReader::close() {
+    // make sure no in-flight prefetch is still using the client before tearing down
+    _drain_prefetch();
+    if (_scroll_id.empty()) {
+        return Status::OK();
+    }
+
+    auto& reaper = scroll_reaper();
+    bool need_schedule = false;
+    {
+        std::lock_guard<std::mutex> l(reaper.mutex);
+        reaper.pending[{_target + REQUEST_SEARCH_SCROLL_PATH, _user_name, _passwd, _ssl_enabled}].push_back(_scroll_id);
+        if (!reaper.flush_scheduled) {
+            reaper.flush_scheduled = true;
+            need_schedule = true;
+        }
+    }
+    if (need_schedule) {
+        auto* thread_pool = ExecEnv::GetInstance()->es_io_pool();
+        bool offered = thread_pool->try_offer([]() {
+            // give readers closing in the same window a chance to pile in
+            std::this_thread::sleep_for(std::chrono::milliseconds(config::es_clear_scroll_batch_window_ms));
+            flush_scroll_reaper();
+        });
+        if (!offered) {
+            LOG(WARNING) << "try to delete scroll id failed";
+            // flush inline so the pending ids are not stranded with no flusher
+            flush_scroll_reaper();
+        }
     }
     return Status::OK();
 }
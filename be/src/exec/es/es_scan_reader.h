@@ -34,6 +34,7 @@
 
 #pragma once
 
+#include <future>
 #include <string>
 
 #include "http/http_client.h"
@@ -52,6 +53,11 @@ public:
     static constexpr const char* KEY_INDEX = "index";
     static constexpr const char* KEY_TYPE = "es.type";
     static constexpr const char* KEY_SHARD = "shard_id";
+    // sliced scroll: FE may split one scroll into independent slices that are
+    // scanned in parallel by separate scan ranges; each reader only tags its
+    // query with its own slice id and the total slice count
+    static constexpr const char* KEY_SLICE_ID = "slice_id";
+    static constexpr const char* KEY_SLICE_MAX = "slice_max";
     static constexpr const char* KEY_QUERY = "query";
     static constexpr const char* KEY_BATCH_SIZE = "batch_size";
     static constexpr const char* KEY_TERMINATE_AFTER = "limit";
@@ -61,7 +67,8 @@ public:
     ESScanReader(const std::string& target, const std::map<std::string, std::string>& props, bool doc_value_mode);
     ~ESScanReader();
 
-    // launch the first scroll request, this method will cache the first scroll response, and return the this cached response when invoke get_next
+    // prepare the http client for the (first) search request; the request itself
+    // is issued lazily by the first get_next call
     Status open();
     // invoke get_next to get next batch documents from elasticsearch
     template <class T>
@@ -70,6 +77,16 @@ public:
     Status close();
 
 private:
+    // issue the request for the next scroll page asynchronously, so the network
+    // round-trip overlaps with parsing/consuming the current batch; falls back to
+    // the synchronous path in get_next when the thread pool is saturated
+    void _launch_next_scroll();
+    // assemble the POST body for the next scroll request from the cached
+    // invariant prefix and the current scroll id
+    std::string _build_next_scroll_body() const;
+    // block until an in-flight prefetch (if any) has finished with the client
+    void _drain_prefetch();
+
     std::string _target;
     std::string _user_name;
     std::string _passwd;
@@ -99,14 +116,21 @@ private:
     // Each call to the scroll API returns the next batch of results until there are no more results left to return
     std::string _next_scroll_url;
 
+    // invariant part of the next-scroll POST body, only the scroll id changes
+    // between pages; see _build_next_scroll_body()
+    std::string _next_scroll_body_prefix;
+
     // _search_url used to exeucte just only one search request to Elasticsearch
     // _search_url would go into effect when `limit` specified:
     // select * from es_table limit 10 -> /es_table/doc/_search?terminate_after=10
     std::string _search_url;
     bool _eos;
-    int _batch_size;
+    int _batch_size = 0;
+
+    // in-flight prefetch of the next scroll page, see _launch_next_scroll()
+    std::future<Status> _prefetch_future;
+    std::string _prefetch_response;
 
-    std::string _cached_response;
     // keep-alive for es scroll
     std::string _scroll_keep_alive;
     // timeout for es http connetion
@@ -61,13 +61,14 @@ std::string json_value_to_string(const rapidjson::Value& value) {
     return scratch_buffer.GetString();
 }
 
-#define RETURN_NULL_IF_STR_EMPTY(col, column)                                          \
-    do {                                                                               \
-        const std::string& null_str = json_value_to_string(col);                       \
-        if ((null_str.length() <= 0 || "\"\"" == null_str) && column->is_nullable()) { \
-            _append_null(column);                                                      \
-            return Status::OK();                                                       \
-        }                                                                              \
+// only an empty string value serializes to an empty ("") literal, so check the
+// value directly instead of serializing every value to a scratch std::string
+#define RETURN_NULL_IF_STR_EMPTY(col, column)                                            \
+    do {                                                                                 \
+        if ((col).IsString() && (col).GetStringLength() == 0 && column->is_nullable()) { \
+            _append_null(column);                                                        \
+            return Status::OK();                                                         \
+        }                                                                                \
     } while (false)
 
 #define RETURN_ERROR_IF_COL_IS_ARRAY(col, type)                               \
@@ -132,15 +133,27 @@ ScrollParser::ScrollParser(bool doc_value_mode)
         : _tuple_desc(nullptr), _doc_value_context(nullptr), _size(0), _cur_line(0), _temp_writer(_scratch_buffer) {}
 
 Status ScrollParser::parse(const std::string& scroll_result, bool exactly_once) {
+    // copying overload, kept for callers that still need the buffer afterwards
+    return parse(std::string(scroll_result), exactly_once);
+}
+
+Status ScrollParser::parse(std::string&& scroll_result, bool exactly_once) {
     _size = 0;
     _cur_line = 0;
-    _document_node.Parse(scroll_result.data(), scroll_result.size());
+    _inner_hits_node = nullptr;
+    // the parser is reused across pages; swap in a fresh document so the pool
+    // allocator of the previous page is released instead of growing forever
+    rapidjson::Document().Swap(_document_node);
+    _scroll_result = std::move(scroll_result);
+    // parse in situ: string values are unescaped in place and point into
+    // _scroll_result instead of being copied into the document allocator
+    _document_node.ParseInsitu(_scroll_result.data());
     if (_document_node.HasParseError()) {
-        return Status::InternalError(fmt::format("Parsing json error, json is: {}", scroll_result));
+        return Status::InternalError(fmt::format("Parsing json error, json is: {}", _scroll_result));
     }
 
     if (!exactly_once && !_document_node.HasMember(FIELD_SCROLL_ID)) {
-        LOG(WARNING) << "Document has not a scroll id field scroll response:" << scroll_result;
+        LOG(WARNING) << "Document has not a scroll id field scroll response:" << _scroll_result;
         return Status::InternalError("Document has not a scroll id field");
     }
 
@@ -160,9 +173,11 @@ Status ScrollParser::parse(const std::string& scroll_result, bool exactly_once)
     if (!inner_hits_node.IsArray()) {
         return Status::OK();
     }
-    _inner_hits_node.CopyFrom(inner_hits_node, _document_node.GetAllocator());
+    // the document is a member with the same lifetime as the parser, so the
+    // hits can be walked in place instead of deep-copying the whole array
+    _inner_hits_node = &inner_hits_node;
     // how many documents contains in this batch
-    _size = _inner_hits_node.Size();
+    _size = _inner_hits_node->Size();
 
     return Status::OK();
 }
@@ -190,7 +205,7 @@ Status ScrollParser::fill_chunk(RuntimeState* state, ChunkPtr* chunk, bool* line
     auto slots = _tuple_desc->slots();
     // TODO: we could fill chunk by column rather than row
     for (size_t i = 0; i < fill_sz; ++i) {
-        const rapidjson::Value& obj = _inner_hits_node[_cur_line + i];
+        const rapidjson::Value& obj = (*_inner_hits_node)[_cur_line + i];
         bool pure_doc_value = _is_pure_doc_value(obj);
         bool has_source = obj.HasMember(FIELD_SOURCE);
         bool has_fields = obj.HasMember(FIELD_FIELDS);
@@ -34,6 +34,9 @@ public:
     ~ScrollParser() = default;
 
     Status parse(const std::string& scroll_result, bool exactly_once = false);
+    // takes ownership of the response body and parses it in situ, avoiding a copy
+    // of the (potentially multi-MB) scroll response
+    Status parse(std::string&& scroll_result, bool exactly_once = false);
     Status fill_chunk(RuntimeState* state, ChunkPtr* chunk, bool* line_eos);
 
     const std::string& get_scroll_id() { return _scroll_id; }
@@ -95,8 +98,12 @@ private:
     std::string _scroll_id;
     size_t _size;
     rapidjson::SizeType _cur_line;
+    // owns the response body; string values of _document_node point into this
+    // buffer (in-situ parsing), so it must outlive the parsed document
+    std::string _scroll_result;
     rapidjson::Document _document_node;
-    rapidjson::Value _inner_hits_node;
+    // points at the hits array inside _document_node, no deep copy involved
+    const rapidjson::Value* _inner_hits_node = nullptr;
 
     rapidjson::StringBuffer _scratch_buffer;
     rapidjson::Writer<rapidjson::StringBuffer> _temp_writer;
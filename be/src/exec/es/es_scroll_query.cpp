@@ -17,8 +17,10 @@
 
 #include "exec/es/es_scroll_query.h"
 
+#include <algorithm>
 #include <sstream>
 
+#include "common/config.h"
 #include "common/logging.h"
 #include "exec/es/es_query_builder.h"
 #include "exec/es/es_scan_reader.h"
@@ -55,6 +57,23 @@ std::string ESScrollQueryBuilder::build_clear_scroll_body(const std::string& scr
     return buffer.GetString();
 }
 
+std::string ESScrollQueryBuilder::build_clear_scroll_body(const std::vector<std::string>& scroll_ids) {
+    // DELETE /_search/scroll accepts a list of ids, one request clears them all
+    rapidjson::Document delete_scroll_dsl;
+    rapidjson::Document::AllocatorType& allocator = delete_scroll_dsl.GetAllocator();
+    delete_scroll_dsl.SetObject();
+    rapidjson::Value scroll_id_array(rapidjson::kArrayType);
+    for (const auto& scroll_id : scroll_ids) {
+        rapidjson::Value scroll_id_value(scroll_id.c_str(), allocator);
+        scroll_id_array.PushBack(scroll_id_value, allocator);
+    }
+    delete_scroll_dsl.AddMember("scroll_id", scroll_id_array, allocator);
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    delete_scroll_dsl.Accept(writer);
+    return buffer.GetString();
+}
+
 std::string ESScrollQueryBuilder::build(const std::map<std::string, std::string>& properties,
                                         const std::vector<std::string>& fields, std::vector<EsPredicate*>& predicates,
                                         const std::map<std::string, std::string>& docvalue_context,
@@ -116,7 +135,23 @@ std::string ESScrollQueryBuilder::build(const std::map<std::string, std::string>
         size = atoi(properties.at(ESScanReader::KEY_TERMINATE_AFTER).c_str());
     } else {
         size = atoi(properties.at(ESScanReader::KEY_BATCH_SIZE).c_str());
+        // keep in sync with the sanitizing in ESScanReader's constructor, the
+        // requested size and the reader's eos check must agree
+        if (size <= 0) {
+            size = config::es_scroll_default_batch_size;
+        }
+        size = std::min(size, config::es_index_max_result_window);
+    }
+    // sliced scroll lets several readers consume one index shard in parallel,
+    // each owning an independent scroll context; FE decides the slice count
+    if (properties.find(ESScanReader::KEY_SLICE_ID) != properties.end() &&
+        properties.find(ESScanReader::KEY_SLICE_MAX) != properties.end()) {
+        rapidjson::Value slice_node(rapidjson::kObjectType);
+        slice_node.AddMember("id", atoi(properties.at(ESScanReader::KEY_SLICE_ID).c_str()), allocator);
+        slice_node.AddMember("max", atoi(properties.at(ESScanReader::KEY_SLICE_MAX).c_str()), allocator);
+        es_query_dsl.AddMember("slice", slice_node, allocator);
     }
+
     rapidjson::Value sort_node(rapidjson::kArrayType);
     // use the scroll-scan mode for scan index documents
     rapidjson::Value field("_doc", allocator);
@@ -31,6 +31,7 @@ public:
     // build the query DSL for elasticsearch
     static std::string build_next_scroll_body(const std::string& scroll_id, const std::string& scroll);
     static std::string build_clear_scroll_body(const std::string& scroll_id);
+    static std::string build_clear_scroll_body(const std::vector<std::string>& scroll_ids);
     // @note: predicates should processed before pass it to this method,
     // tie breaker for predicate wheather can push down es can reference the push-down filters
     static std::string build(const std::map<std::string, std::string>& properties,
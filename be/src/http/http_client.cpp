@@ -17,11 +17,47 @@
 
 #include "http/http_client.h"
 
+#include <array>
+#include <mutex>
+
 #include "common/config.h"
 #include "fs/fs_util.h"
 
 namespace starrocks {
 
+// a process-wide share handle lets opted-in easy handles draw on a common dns
+// cache, tls session cache and (libcurl >= 7.57) idle connection cache, so
+// clients fanning out to the same host do not each pay resolution and
+// handshake costs; the share object requires external locking per data kind
+static std::array<std::mutex, CURL_LOCK_DATA_LAST> s_curl_share_locks;
+
+static void curl_share_lock(CURL* /*handle*/, curl_lock_data data, curl_lock_access /*access*/, void* /*userptr*/) {
+    s_curl_share_locks[data].lock();
+}
+
+static void curl_share_unlock(CURL* /*handle*/, curl_lock_data data, void* /*userptr*/) {
+    s_curl_share_locks[data].unlock();
+}
+
+static CURLSH* curl_share_handle() {
+    static CURLSH* s_share = []() {
+        CURLSH* share = curl_share_init();
+        curl_share_setopt(share, CURLSHOPT_LOCKFUNC, curl_share_lock);
+        curl_share_setopt(share, CURLSHOPT_UNLOCKFUNC, curl_share_unlock);
+        curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+        curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+#if LIBCURL_VERSION_NUM >= 0x073900
+        curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+#endif
+        return share;
+    }();
+    return s_share;
+}
+
+void HttpClient::use_shared_connection_cache() {
+    curl_easy_setopt(_curl, CURLOPT_SHARE, curl_share_handle());
+}
+
 HttpClient::HttpClient() = default;
 
 HttpClient::~HttpClient() {
@@ -113,6 +149,15 @@ Status HttpClient::init(const std::string& url) {
     return Status::OK();
 }
 
+Status HttpClient::set_url(const std::string& url) {
+    auto code = curl_easy_setopt(_curl, CURLOPT_URL, url.c_str());
+    if (code != CURLE_OK) {
+        LOG(WARNING) << "failed to set CURLOPT_URL, errmsg=" << _to_errmsg(code);
+        return Status::InternalError("fail to set CURLOPT_URL");
+    }
+    return Status::OK();
+}
+
 void HttpClient::set_method(HttpMethod method) {
     switch (method) {
     case GET:
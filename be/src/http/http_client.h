@@ -46,6 +46,11 @@ public:
     // you can call this multiple times to reuse this object
     Status init(const std::string& url);
 
+    // change the request URL without resetting the curl handle, so the
+    // established connection (and TLS session) can be reused for the
+    // next request against the same host
+    Status set_url(const std::string& url);
+
     void set_method(HttpMethod method);
 
     void set_basic_auth(const std::string& user, const std::string& passwd) {
@@ -66,10 +71,19 @@ public:
         curl_easy_setopt(_curl, CURLOPT_COPYPOSTFIELDS, post_body.c_str());
     }
 
-    // TODO(zc): support set header
-    // void set_header(const std::string& key, const std::string& value) {
-    // _cntl.http_request().SetHeader(key, value);
-    // }
+    void set_header(const std::string& key, const std::string& value) {
+        std::string scratch_str = key + ": " + value;
+        _header_list = curl_slist_append(_header_list, scratch_str.c_str());
+        curl_easy_setopt(_curl, CURLOPT_HTTPHEADER, _header_list);
+    }
+
+    // allow the underlying connection to be reused by subsequent requests and
+    // enable TCP keep-alive probes, so that a sequence of requests against the
+    // same endpoint pays the TCP/TLS handshake cost only once
+    void set_keep_alive() {
+        curl_easy_setopt(_curl, CURLOPT_FORBID_REUSE, 0L);
+        curl_easy_setopt(_curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    }
 
     std::string get_response_content_type() {
         char* ct = nullptr;
@@ -86,10 +100,28 @@ public:
 
     void set_timeout_ms(int64_t timeout_ms) { curl_easy_setopt(_curl, CURLOPT_TIMEOUT_MS, timeout_ms); }
 
+    // advertise the given Accept-Encoding (e.g. "gzip,deflate"); libcurl
+    // decompresses the response transparently, an empty string enables all
+    // encodings curl was built with
+    void set_accept_encoding(const std::string& encoding) {
+        curl_easy_setopt(_curl, CURLOPT_ACCEPT_ENCODING, encoding.c_str());
+    }
+
     void trust_all_ssl() {
         curl_easy_setopt(_curl, CURLOPT_SSL_VERIFYPEER, 0L);
         curl_easy_setopt(_curl, CURLOPT_SSL_VERIFYHOST, 0L);
     }
+
+    // attach this handle to the process-wide curl share object so dns results,
+    // tls sessions and idle connections are pooled with every other client
+    // that opted in, instead of each handle building its own
+    void use_shared_connection_cache();
+
+    // cache TLS session ids/tickets within this handle so a reconnect resumes
+    // the previous session instead of running a full handshake; on by default
+    // in libcurl, this just guards against it being disabled elsewhere
+    void enable_ssl_session_cache() { curl_easy_setopt(_curl, CURLOPT_SSL_SESSIONID_CACHE, 1L); }
+
     // used to get content length
     int64_t get_content_length() const {
         // CURLINFO_CONTENT_LENGTH_DOWNLOAD is deprecated since v7.55.0
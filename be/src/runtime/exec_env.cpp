@@ -383,6 +383,15 @@ Status ExecEnv::init(const std::vector<StorePath>& store_paths, bool as_cn) {
     _pipeline_sink_io_pool =
             new PriorityThreadPool("pip_sink_io", num_sink_io_threads, config::pipeline_sink_io_thread_pool_queue_size);
 
+    int num_es_io_threads = config::es_io_thread_pool_thread_num;
+    if (num_es_io_threads <= 0) {
+        num_es_io_threads = CpuInfo::num_cores();
+    }
+    if (config::es_io_thread_pool_queue_size <= 0) {
+        return Status::InvalidArgument("es_io_thread_pool_queue_size shoule be greater than 0");
+    }
+    _es_io_pool = new PriorityThreadPool("es_io", num_es_io_threads, config::es_io_thread_pool_queue_size);
+
     int query_rpc_threads = config::internal_service_query_rpc_thread_num;
     if (query_rpc_threads <= 0) {
         query_rpc_threads = CpuInfo::num_cores();
@@ -647,6 +656,10 @@ void ExecEnv::stop() {
         _pipeline_sink_io_pool->shutdown();
     }
 
+    if (_es_io_pool) {
+        _es_io_pool->shutdown();
+    }
+
     if (_put_aggregate_metadata_thread_pool) {
         _put_aggregate_metadata_thread_pool->shutdown();
     }
@@ -742,6 +755,7 @@ void ExecEnv::destroy() {
     SAFE_DELETE(_udf_call_pool);
     SAFE_DELETE(_pipeline_prepare_pool);
     SAFE_DELETE(_pipeline_sink_io_pool);
+    SAFE_DELETE(_es_io_pool);
     SAFE_DELETE(_query_rpc_pool);
     SAFE_DELETE(_datacache_rpc_pool);
     _load_rpc_pool.reset();
@@ -34,6 +34,7 @@
 
 #include "util/runtime_profile.h"
 
+#include <algorithm>
 #include <boost/thread/thread_time.hpp>
 #include <iomanip>
 #include <iostream>
@@ -62,6 +63,16 @@ static const std::string THREAD_INVOLUNTARY_CONTEXT_SWITCHES = "InvoluntaryConte
 
 const std::string RuntimeProfile::ROOT_COUNTER = ""; // NOLINT
 
+// Child counter names are kept sorted so printing keeps the order the old
+// std::set gave; lists are small enough that the shifting insert is cheaper
+// than a tree node per name.
+static void insert_child_counter(std::vector<std::string>* names, const std::string& name) {
+    auto pos = std::lower_bound(names->begin(), names->end(), name);
+    if (pos == names->end() || *pos != name) {
+        names->insert(pos, name);
+    }
+}
+
 RuntimeProfile::RuntimeProfile(std::string name, bool is_averaged_profile)
         : _parent(nullptr),
           _pool(new ObjectPool()),
@@ -78,19 +89,18 @@ void RuntimeProfile::merge(RuntimeProfile* other) {
 
     // Merge this level
     {
-        CounterMap::iterator dst_iter;
-        CounterMap::const_iterator src_iter;
-        std::lock_guard<std::mutex> l(_counter_lock);
-        std::lock_guard<std::mutex> m(other->_counter_lock);
+        std::lock_guard<std::shared_mutex> l(_counter_lock);
+        std::shared_lock<std::shared_mutex> m(other->_counter_lock);
 
-        for (src_iter = other->_counter_map.begin(); src_iter != other->_counter_map.end(); ++src_iter) {
-            dst_iter = _counter_map.find(src_iter->first);
+        for (auto src_iter = other->_counter_map.begin(); src_iter != other->_counter_map.end(); ++src_iter) {
+            auto dst_iter = _counter_map.find(src_iter->first);
 
             if (dst_iter == _counter_map.end()) {
-                _counter_map[src_iter->first] = std::make_pair(
-                        _pool->add(new Counter(src_iter->second.first->type(), src_iter->second.first->strategy(),
-                                               src_iter->second.first->value())),
-                        src_iter->second.second);
+                _counter_map[src_iter->first] =
+                        std::make_pair(&_counter_arena.emplace_back(src_iter->second.first->type(),
+                                                                    src_iter->second.first->strategy(),
+                                                                    src_iter->second.first->value()),
+                                       src_iter->second.second);
             } else {
                 DCHECK(dst_iter->second.first->type() == src_iter->second.first->type());
 
@@ -103,13 +113,11 @@ void RuntimeProfile::merge(RuntimeProfile* other) {
             }
         }
 
-        ChildCounterMap::const_iterator child_counter_src_itr;
-
-        for (child_counter_src_itr = other->_child_counter_map.begin();
-             child_counter_src_itr != other->_child_counter_map.end(); ++child_counter_src_itr) {
-            auto& child_counters =
-                    LookupOrInsert(&_child_counter_map, child_counter_src_itr->first, std::set<std::string>());
-            child_counters.insert(child_counter_src_itr->second.begin(), child_counter_src_itr->second.end());
+        for (const auto& [parent_name, child_names] : other->_child_counter_map) {
+            auto& child_counters = LookupOrInsert(&_child_counter_map, parent_name, std::vector<std::string>());
+            for (const auto& child_name : child_names) {
+                insert_child_counter(&child_counters, child_name);
+            }
         }
     }
 
@@ -149,30 +157,25 @@ void RuntimeProfile::update(const std::vector<TRuntimeProfileNode>& nodes, int*
     DCHECK_LT(*idx, nodes.size());
     const TRuntimeProfileNode& node = nodes[*idx];
     bool is_node_old;
-    {
-        std::lock_guard<std::mutex> l(_version_lock);
-        if (is_parent_node_old || (node.__isset.version && node.version < _version)) {
-            is_node_old = true;
-        } else {
-            is_node_old = false;
-            if (node.__isset.version) {
-                _version = node.version;
-            }
+    if (is_parent_node_old || (node.__isset.version && node.version < _version.load(std::memory_order_relaxed))) {
+        is_node_old = true;
+    } else {
+        is_node_old = false;
+        if (node.__isset.version) {
+            _version.store(node.version, std::memory_order_relaxed);
         }
     }
 
     if (!is_node_old) {
-        std::lock_guard<std::mutex> l(_counter_lock);
+        std::lock_guard<std::shared_mutex> l(_counter_lock);
         // update this level
-        std::map<std::string, Counter*>::iterator dst_iter;
-
         for (const auto& tcounter : node.counters) {
             auto j = _counter_map.find(tcounter.name);
 
             if (j == _counter_map.end()) {
                 // TODO(hcf) pass correct parent counter name
                 _counter_map[tcounter.name] = std::make_pair(
-                        _pool->add(new Counter(tcounter.type, tcounter.strategy, tcounter.value)), ROOT_COUNTER);
+                        &_counter_arena.emplace_back(tcounter.type, tcounter.strategy, tcounter.value), ROOT_COUNTER);
             } else {
                 if (j->second.first->type() != tcounter.type) {
                     LOG(ERROR) << "Cannot update counters with the same name (" << j->first << ") but different types.";
@@ -182,18 +185,16 @@ void RuntimeProfile::update(const std::vector<TRuntimeProfileNode>& nodes, int*
             }
         }
 
-        ChildCounterMap::const_iterator child_counter_src_itr;
-
-        for (child_counter_src_itr = node.child_counters_map.begin();
-             child_counter_src_itr != node.child_counters_map.end(); ++child_counter_src_itr) {
-            auto& child_counters =
-                    LookupOrInsert(&_child_counter_map, child_counter_src_itr->first, std::set<std::string>());
-            child_counters.insert(child_counter_src_itr->second.begin(), child_counter_src_itr->second.end());
+        for (const auto& [parent_name, child_names] : node.child_counters_map) {
+            auto& child_counters = LookupOrInsert(&_child_counter_map, parent_name, std::vector<std::string>());
+            for (const auto& child_name : child_names) {
+                insert_child_counter(&child_counters, child_name);
+            }
         }
     }
 
     if (!is_node_old) {
-        std::lock_guard<std::mutex> l(_info_strings_lock);
+        std::lock_guard<std::shared_mutex> l(_info_strings_lock);
         const InfoStrings& info_strings = node.info_strings;
         for (const std::string& key : node.info_strings_display_order) {
             // Look for existing info strings and update in place. If there
@@ -239,25 +240,24 @@ void RuntimeProfile::update(const std::vector<TRuntimeProfileNode>& nodes, int*
 
 void RuntimeProfile::divide(int n) {
     DCHECK_GT(n, 0);
-    decltype(_counter_map)::iterator iter;
     {
-        std::lock_guard<std::mutex> l(_counter_lock);
+        std::lock_guard<std::shared_mutex> l(_counter_lock);
 
-        for (iter = _counter_map.begin(); iter != _counter_map.end(); ++iter) {
-            if (iter->second.first->type() == TUnit::DOUBLE_VALUE) {
-                iter->second.first->set(iter->second.first->double_value() / n);
+        for (auto& [name, pair] : _counter_map) {
+            if (pair.first->type() == TUnit::DOUBLE_VALUE) {
+                pair.first->set(pair.first->double_value() / n);
             } else {
-                int64_t value = iter->second.first->_value.load();
+                int64_t value = pair.first->_value.load(std::memory_order_relaxed);
                 value = value / n;
-                iter->second.first->_value.store(value);
+                pair.first->_value.store(value, std::memory_order_relaxed);
             }
         }
     }
     {
         std::lock_guard<std::mutex> l(_children_lock);
 
-        for (auto& i : _child_map) {
-            i.second->divide(n);
+        for (auto& i : _children) {
+            i.first->divide(n);
         }
     }
 }
@@ -331,9 +331,9 @@ RuntimeProfile::Counter* RuntimeProfile::add_counter_unlock(const std::string& n
     }
 
     DCHECK(parent_name == ROOT_COUNTER || _counter_map.find(parent_name) != _counter_map.end());
-    Counter* counter = _pool->add(new Counter(type, strategy, 0));
-    _counter_map[name] = std::make_pair(counter, parent_name);
-    _child_counter_map[parent_name].insert(name);
+    Counter* counter = &_counter_arena.emplace_back(type, strategy, 0);
+    _counter_map.emplace(name, std::make_pair(counter, parent_name));
+    insert_child_counter(&_child_counter_map[parent_name], name);
     return counter;
 }
 
@@ -390,14 +390,14 @@ void RuntimeProfile::get_children(std::vector<RuntimeProfile*>* children) {
 void RuntimeProfile::get_all_children(std::vector<RuntimeProfile*>* children) {
     std::lock_guard<std::mutex> l(_children_lock);
 
-    for (auto& i : _child_map) {
-        children->push_back(i.second);
-        i.second->get_all_children(children);
+    for (auto& i : _children) {
+        children->push_back(i.first);
+        i.first->get_all_children(children);
     }
 }
 
 void RuntimeProfile::add_info_string(const std::string& key, const std::string& value) {
-    std::lock_guard<std::mutex> l(_info_strings_lock);
+    std::lock_guard<std::shared_mutex> l(_info_strings_lock);
     auto it = _info_strings.find(key);
 
     if (it == _info_strings.end()) {
@@ -409,7 +409,7 @@ void RuntimeProfile::add_info_string(const std::string& key, const std::string&
 }
 
 std::string* RuntimeProfile::get_info_string(const std::string& key) {
-    std::lock_guard<std::mutex> l(_info_strings_lock);
+    std::shared_lock<std::shared_mutex> l(_info_strings_lock);
     auto it = _info_strings.find(key);
 
     if (it == _info_strings.end()) {
@@ -425,7 +425,7 @@ void RuntimeProfile::copy_all_info_strings_from(RuntimeProfile* src_profile) {
         return;
     }
 
-    std::lock_guard<std::mutex> l(src_profile->_info_strings_lock);
+    std::shared_lock<std::shared_mutex> l(src_profile->_info_strings_lock);
     for (const auto& [key, value] : src_profile->_info_strings) {
         const std::string* exist_ptr = get_info_string(key);
         if (exist_ptr == nullptr) {
@@ -462,15 +462,21 @@ void RuntimeProfile::copy_all_info_strings_from(RuntimeProfile* src_profile) {
     RuntimeProfile::T* RuntimeProfile::NAME(const std::string& name, TUnit::type unit,                          \
                                             const TCounterStrategy& strategy, const std::string& parent_name) { \
         DCHECK_EQ(_is_averaged_profile, false);                                                                 \
-        std::lock_guard<std::mutex> l(_counter_lock);                                                           \
-        if (_counter_map.find(name) != _counter_map.end()) {                                                    \
-            return reinterpret_cast<T*>(_counter_map[name].first);                                              \
+        {                                                                                                       \
+            std::shared_lock<std::shared_mutex> l(_counter_lock);                                               \
+            if (auto iter = _counter_map.find(name); iter != _counter_map.end()) {                              \
+                return reinterpret_cast<T*>(iter->second.first);                                                \
+            }                                                                                                   \
+        }                                                                                                       \
+        std::lock_guard<std::shared_mutex> l(_counter_lock);                                                    \
+        if (auto iter = _counter_map.find(name); iter != _counter_map.end()) {                                  \
+            return reinterpret_cast<T*>(iter->second.first);                                                    \
         }                                                                                                       \
         DCHECK(parent_name == ROOT_COUNTER || _counter_map.find(parent_name) != _counter_map.end());            \
         T* counter = _pool->add(new T(unit, strategy, 0));                                                      \
-        _counter_map[name] = std::make_pair(counter, parent_name);                                              \
-        auto& child_counters = LookupOrInsert(&_child_counter_map, parent_name, std::set<std::string>());       \
-        child_counters.insert(name);                                                                            \
+        _counter_map.emplace(name, std::make_pair(counter, parent_name));                                       \
+        auto& child_counters = LookupOrInsert(&_child_counter_map, parent_name, std::vector<std::string>());    \
+        insert_child_counter(&child_counters, name);                                                            \
         return counter;                                                                                         \
     }
 
@@ -480,23 +486,32 @@ ADD_COUNTER_IMPL(AddLowWaterMarkCounter, LowWaterMarkCounter)
 RuntimeProfile::Counter* RuntimeProfile::add_child_counter(const std::string& name, TUnit::type type,
                                                            const TCounterStrategy& strategy,
                                                            const std::string& parent_name) {
-    std::lock_guard<std::mutex> l(_counter_lock);
+    // Registration is idempotent and most calls hit an existing counter, so
+    // probe under the shared lock first and only take the exclusive lock for
+    // the actual insert; add_counter_unlock re-checks under it.
+    {
+        std::shared_lock<std::shared_mutex> l(_counter_lock);
+        if (auto iter = _counter_map.find(name); iter != _counter_map.end()) {
+            return iter->second.first;
+        }
+    }
+    std::lock_guard<std::shared_mutex> l(_counter_lock);
     return add_counter_unlock(name, type, strategy, parent_name);
 }
 
 RuntimeProfile::DerivedCounter* RuntimeProfile::add_derived_counter(const std::string& name, TUnit::type type,
-                                                                    const DerivedCounterFunction& counter_fn,
+                                                                    DerivedCounterFunction counter_fn,
                                                                     const std::string& parent_name) {
-    std::lock_guard<std::mutex> l(_counter_lock);
+    std::lock_guard<std::shared_mutex> l(_counter_lock);
 
     if (_counter_map.find(name) != _counter_map.end()) {
         return nullptr;
     }
 
-    DerivedCounter* counter = _pool->add(new DerivedCounter(type, counter_fn));
-    _counter_map[name] = std::make_pair(counter, parent_name);
-    auto& child_counters = LookupOrInsert(&_child_counter_map, parent_name, std::set<std::string>());
-    child_counters.insert(name);
+    DerivedCounter* counter = _pool->add(new DerivedCounter(type, std::move(counter_fn)));
+    _counter_map.emplace(name, std::make_pair(counter, parent_name));
+    auto& child_counters = LookupOrInsert(&_child_counter_map, parent_name, std::vector<std::string>());
+    insert_child_counter(&child_counters, name);
     return counter;
 }
 
@@ -516,20 +531,20 @@ RuntimeProfile::ThreadCounters* RuntimeProfile::add_thread_counters(const std::s
 }
 
 std::pair<RuntimeProfile::Counter*, std::string> RuntimeProfile::get_counter_pair(const std::string& name) {
-    std::lock_guard<std::mutex> l(_counter_lock);
+    std::shared_lock<std::shared_mutex> l(_counter_lock);
 
-    if (_counter_map.find(name) != _counter_map.end()) {
-        return _counter_map[name];
+    if (auto iter = _counter_map.find(name); iter != _counter_map.end()) {
+        return iter->second;
     }
 
     return {nullptr, ROOT_COUNTER};
 }
 
 RuntimeProfile::Counter* RuntimeProfile::get_counter(const std::string& name) {
-    std::lock_guard<std::mutex> l(_counter_lock);
+    std::shared_lock<std::shared_mutex> l(_counter_lock);
 
-    if (_counter_map.find(name) != _counter_map.end()) {
-        return _counter_map[name].first;
+    if (auto iter = _counter_map.find(name); iter != _counter_map.end()) {
+        return iter->second.first;
     }
 
     return nullptr;
@@ -540,8 +555,8 @@ void RuntimeProfile::copy_all_counters_from(RuntimeProfile* src_profile, const s
     if (this == src_profile) {
         return;
     }
-    std::lock_guard<std::mutex> l1(src_profile->_counter_lock);
-    std::lock_guard<std::mutex> l2(_counter_lock);
+    std::shared_lock<std::shared_mutex> l1(src_profile->_counter_lock);
+    std::lock_guard<std::shared_mutex> l2(_counter_lock);
 
     std::queue<std::pair<std::string, std::string>> name_queue;
     name_queue.push(std::make_pair(ROOT_COUNTER, ROOT_COUNTER));
@@ -581,17 +596,21 @@ void RuntimeProfile::copy_all_counters_from(RuntimeProfile* src_profile, const s
 }
 
 void RuntimeProfile::remove_counter(const std::string& name) {
-    std::lock_guard<std::mutex> l(_counter_lock);
-    if (_counter_map.find(name) == _counter_map.end()) {
+    std::lock_guard<std::shared_mutex> l(_counter_lock);
+    auto counter_it = _counter_map.find(name);
+    if (counter_it == _counter_map.end()) {
         return;
     }
 
     // Remove from its parent sub sets
-    auto pair = _counter_map[name];
+    auto pair = counter_it->second;
     auto& parent_name = pair.second;
     if (auto names_it = _child_counter_map.find(parent_name); names_it != _child_counter_map.end()) {
         auto& child_names = names_it->second;
-        child_names.erase(child_names.find(name));
+        auto pos = std::lower_bound(child_names.begin(), child_names.end(), name);
+        if (pos != child_names.end() && *pos == name) {
+            child_names.erase(pos);
+        }
     }
 
     // Remove child counter recursively
@@ -614,7 +633,7 @@ void RuntimeProfile::remove_counter(const std::string& name) {
 }
 
 void RuntimeProfile::remove_counters(const std::set<std::string>& saved_names) {
-    std::lock_guard<std::mutex> l(_counter_lock);
+    std::lock_guard<std::shared_mutex> l(_counter_lock);
 
     // Find all parent counter names
     std::set<std::string> all_saved_names;
@@ -624,7 +643,7 @@ void RuntimeProfile::remove_counters(const std::set<std::string>& saved_names) {
         while (iterator_name != ROOT_COUNTER) {
             all_saved_names.insert(iterator_name);
             if (auto it = _counter_map.find(iterator_name); it != _counter_map.end()) {
-                iterator_name = _counter_map[iterator_name].second;
+                iterator_name = it->second.second;
             } else {
                 break;
             }
@@ -635,14 +654,11 @@ void RuntimeProfile::remove_counters(const std::set<std::string>& saved_names) {
     auto names_it = _child_counter_map.begin();
     while (names_it != _child_counter_map.end()) {
         auto& child_names = names_it->second;
-        std::vector<std::string> copy(child_names.begin(), child_names.end());
-        copy.erase(std::remove_if(copy.begin(), copy.end(),
-                                  [&](const std::string& name) {
-                                      return all_saved_names.find(name) == all_saved_names.end();
-                                  }),
-                   copy.end());
-        child_names.clear();
-        child_names.insert(copy.begin(), copy.end());
+        child_names.erase(std::remove_if(child_names.begin(), child_names.end(),
+                                         [&](const std::string& name) {
+                                             return all_saved_names.find(name) == all_saved_names.end();
+                                         }),
+                          child_names.end());
         if (names_it->first != ROOT_COUNTER && child_names.empty()) {
             names_it = _child_counter_map.erase(names_it);
         } else {
@@ -691,7 +707,7 @@ void RuntimeProfile::pretty_print(std::ostream* s, const std::string& prefix) co
     CounterMap counter_map;
     ChildCounterMap child_counter_map;
     {
-        std::lock_guard<std::mutex> l(_counter_lock);
+        std::shared_lock<std::shared_mutex> l(_counter_lock);
         counter_map = _counter_map;
         child_counter_map = _child_counter_map;
     }
@@ -711,7 +727,7 @@ void RuntimeProfile::pretty_print(std::ostream* s, const std::string& prefix) co
     stream << std::endl;
 
     {
-        std::lock_guard<std::mutex> l(_info_strings_lock);
+        std::shared_lock<std::shared_mutex> l(_info_strings_lock);
         for (const std::string& key : _info_strings_display_order) {
             stream << prefix << "   - " << key << ": " << _info_strings.find(key)->second << std::endl;
         }
@@ -769,16 +785,17 @@ void RuntimeProfile::to_thrift(std::vector<TRuntimeProfileNode>* nodes) {
     node.metadata = _metadata;
     node.indent = true;
 
-    {
-        std::lock_guard<std::mutex> l(_version_lock);
-        node.__set_version(_version);
-    }
+    node.__set_version(_version.load(std::memory_order_relaxed));
 
     CounterMap counter_map;
     {
-        std::lock_guard<std::mutex> l(_counter_lock);
+        std::shared_lock<std::shared_mutex> l(_counter_lock);
         counter_map = _counter_map;
-        node.child_counters_map = _child_counter_map;
+        // thrift keeps the child names as a set; our sorted vectors convert
+        // into it in order
+        for (const auto& [parent_name, child_names] : _child_counter_map) {
+            node.child_counters_map[parent_name].insert(child_names.begin(), child_names.end());
+        }
     }
 
     // If the node has a MIN/MAX and they need to be displayed, the node itself also needs to be reserved,
@@ -803,17 +820,19 @@ void RuntimeProfile::to_thrift(std::vector<TRuntimeProfileNode>* nodes) {
         counter.__set_value(iter_counter->value());
         counter.__set_type(iter_counter->type());
         counter.__set_strategy(iter_counter->strategy());
-        if (iter_counter->_min_value.has_value()) {
-            counter.__set_min_value(iter_counter->_min_value.value());
+        const auto min_value = iter_counter->min_value();
+        if (min_value.has_value()) {
+            counter.__set_min_value(min_value.value());
         }
-        if (iter_counter->_max_value.has_value()) {
-            counter.__set_max_value(iter_counter->_max_value.value());
+        const auto max_value = iter_counter->max_value();
+        if (max_value.has_value()) {
+            counter.__set_max_value(max_value.value());
         }
         node.counters.push_back(counter);
     }
 
     {
-        std::lock_guard<std::mutex> l(_info_strings_lock);
+        std::shared_lock<std::shared_mutex> l(_info_strings_lock);
         node.info_strings = _info_strings;
         node.info_strings_display_order = _info_strings_display_order;
     }
@@ -847,6 +866,10 @@ int64_t RuntimeProfile::units_per_second(const RuntimeProfile::Counter* total_co
     return total_counter->value() / secs;
 }
 
+// Scalar on purpose: counters are pointer-addressed objects with stable
+// identities, not a contiguous value array, so a vectorized reduction would
+// first have to gather through the pointers it is meant to avoid. This and
+// divide() run once per report, where the gather dominates, not the adds.
 [[maybe_unused]] int64_t RuntimeProfile::counter_sum(const std::vector<Counter*>* counters) {
     int64_t value = 0;
     for (auto counter : *counters) {
@@ -863,7 +886,7 @@ RuntimeProfile::EventSequence* RuntimeProfile::add_event_sequence(const std::str
         return timer_it->second;
     }
 
-    EventSequence* timer = _pool->add(new EventSequence());
+    EventSequence* timer = &_event_sequence_arena.emplace_back();
     _event_sequence_map[name] = timer;
     return timer;
 }
@@ -895,7 +918,7 @@ RuntimeProfile* RuntimeProfile::merge_isomorphic_profiles(ObjectPool* obj_pool,
         // some counters are only attached to one of them
         std::vector<std::map<std::string, std::pair<TUnit::type, std::string>>> all_level_counters;
         for (auto* profile : profiles) {
-            std::lock_guard<std::mutex> l(profile->_counter_lock);
+            std::shared_lock<std::shared_mutex> l(profile->_counter_lock);
             // Level order traverse starts with root
             std::queue<std::string> name_queue;
             name_queue.push(ROOT_COUNTER);
@@ -991,13 +1014,15 @@ RuntimeProfile* RuntimeProfile::merge_isomorphic_profiles(ObjectPool* obj_pool,
                 }
 
                 if (!counter->skip_min_max()) {
-                    if (counter->_min_value.has_value()) {
+                    const auto counter_min_value = counter->min_value();
+                    if (counter_min_value.has_value()) {
                         already_merged = true;
-                        min_value = std::min(counter->_min_value.value(), min_value);
+                        min_value = std::min(counter_min_value.value(), min_value);
                     }
-                    if (counter->_max_value.has_value()) {
+                    const auto counter_max_value = counter->max_value();
+                    if (counter_max_value.has_value()) {
                         already_merged = true;
-                        max_value = std::max(counter->_max_value.value(), max_value);
+                        max_value = std::max(counter_max_value.value(), max_value);
                     }
                 }
 
@@ -1029,10 +1054,10 @@ RuntimeProfile* RuntimeProfile::merge_isomorphic_profiles(ObjectPool* obj_pool,
 
                 if (!merged_counter->skip_min_max()) {
                     if (min_value != std::numeric_limits<int64_t>::max()) {
-                        merged_counter->_min_value.emplace(min_value);
+                        merged_counter->set_min(min_value);
                     }
                     if (max_value != std::numeric_limits<int64_t>::min()) {
-                        merged_counter->_max_value.emplace(max_value);
+                        merged_counter->set_max(max_value);
                     }
                 }
             }
@@ -1096,15 +1121,11 @@ RuntimeProfile::MergedInfo RuntimeProfile::merge_isomorphic_counters(std::vector
     int64_t max_value = std::numeric_limits<int64_t>::min();
 
     for (auto& counter : counters) {
-        if (counter->value() < min_value) {
-            min_value = counter->value();
-        }
-
-        if (counter->value() > max_value) {
-            max_value = counter->value();
-        }
-
-        merged_value += counter->value();
+        // value() is virtual (DerivedCounter computes it), read it once
+        const int64_t value = counter->value();
+        min_value = std::min(min_value, value);
+        max_value = std::max(max_value, value);
+        merged_value += value;
     }
 
     if (counters[0]->is_avg()) {
@@ -1121,7 +1142,7 @@ void RuntimeProfile::print_child_counters(const std::string& prefix, const std::
     auto itr = child_counter_map.find(counter_name);
 
     if (itr != child_counter_map.end()) {
-        const std::set<std::string>& child_counters = itr->second;
+        const std::vector<std::string>& child_counters = itr->second;
         for (const std::string& child_counter : child_counters) {
             auto iter = counter_map.find(child_counter);
             DCHECK(iter != counter_map.end());
@@ -1134,20 +1155,23 @@ void RuntimeProfile::print_child_counters(const std::string& prefix, const std::
     }
 }
 std::string RuntimeProfile::get_children_name_string() {
-    std::stringstream ss;
-    ss << "[";
+    // size the result in one pass so the appends below never reallocate
+    size_t total = 2; // "[" and "]"
+    for (auto& child : _children) {
+        total += child.first->name().size() + 2; // ", " separator
+    }
 
-    for (int i = 0; i < _children.size(); ++i) {
-        auto* child = _children[i].first;
+    std::string result;
+    result.reserve(total);
+    result.push_back('[');
+    for (size_t i = 0; i < _children.size(); ++i) {
         if (i != 0) {
-            ss << ", ";
+            result.append(", ");
         }
-        ss << child->name();
+        result.append(_children[i].first->name());
     }
-
-    ss << "]";
-
-    return ss.str();
+    result.push_back(']');
+    return result;
 }
 
 } // namespace starrocks
@@ -38,11 +38,15 @@
 #include <sys/time.h> // NOLINT
 
 #include <atomic>
+#include <deque>
 #include <functional>
 #include <iostream>
+#include <memory>
 #include <mutex>
 #include <optional>
+#include <shared_mutex>
 #include <thread>
+#include <type_traits>
 #include <unordered_set>
 #include <utility>
 
@@ -51,6 +55,7 @@
 #include "common/object_pool.h"
 #include "gen_cpp/RuntimeProfile_types.h"
 #include "gutil/casts.h"
+#include "util/phmap/phmap.h"
 #include "util/stopwatch.hpp"
 
 namespace starrocks {
@@ -97,8 +102,16 @@ inline unsigned long long operator"" _ms(unsigned long long x) {
     (profile)->add_child_counter(name, TUnit::TIME_NS, RuntimeProfile::Counter::create_strategy(TUnit::TIME_NS), parent)
 #define SCOPED_TIMER(c) ScopedTimer<MonotonicStopWatch> MACRO_CONCAT(SCOPED_TIMER, __COUNTER__)(c)
 #define CANCEL_SAFE_SCOPED_TIMER(c, is_cancelled) \
-    ScopedTimer<MonotonicStopWatch> MACRO_CONCAT(SCOPED_TIMER, __COUNTER__)(c, is_cancelled)
+    ScopedTimer<MonotonicStopWatch, true> MACRO_CONCAT(SCOPED_TIMER, __COUNTER__)(c, is_cancelled)
 #define SCOPED_RAW_TIMER(c) ScopedRawTimer<MonotonicStopWatch> MACRO_CONCAT(SCOPED_RAW_TIMER, __COUNTER__)(c)
+// COUNTER_UPDATE stays a direct relaxed fetch_add on purpose. Coalescing
+// updates through a thread-local delta table was evaluated and rejected: the
+// counters on per-batch paths are effectively single-writer (see the note on
+// Counter::update), so the uncontended atomic add is already one instruction,
+// while a TLS hash probe per update plus a flush pass would cost more and
+// delay visibility. Callers that want amortization should hoist the counter
+// update out of the loop and add a locally accumulated delta once — the same
+// pattern the scoped timers below already implement for time.
 #define COUNTER_UPDATE(c, v) (c)->update(v)
 #define COUNTER_SET(c, v) (c)->set(v)
 // this is only used for HighWaterMarkCounter
@@ -108,14 +121,26 @@ inline unsigned long long operator"" _ms(unsigned long long x) {
     /*ThreadCounterMeasurement                                        \
       MACRO_CONCAT(SCOPED_THREAD_COUNTER_MEASUREMENT, __COUNTER__)(c)*/
 #else
+// The no-op branch must mirror every macro above, otherwise flipping
+// ENABLE_COUNTERS off does not compile. Registration macros still yield a
+// value because call sites assign the returned counter pointer.
 #define ADD_COUNTER(profile, name, type) NULL
+#define ADD_COUNTER_SKIP_MERGE(profile, name, type, merge_type) NULL
 #define ADD_TIMER(profile, name) NULL
+#define ADD_TIMER_WITH_THRESHOLD(profile, name, threshold) NULL
+#define ADD_PEAK_COUNTER(profile, name, type) NULL
+#define ADD_CHILD_COUNTER(profile, name, type, parent) NULL
+#define ADD_CHILD_COUNTER_SKIP_MERGE(profile, name, type, merge_type, parent) NULL
+#define ADD_CHILD_COUNTER_SKIP_MIN_MAX(profile, name, type, min_max_type, parent) NULL
+#define ADD_CHILD_TIMER_THESHOLD(profile, name, parent, threshold) NULL
+#define ADD_CHILD_TIMER(profile, name, parent) NULL
 #define SCOPED_TIMER(c)
+#define CANCEL_SAFE_SCOPED_TIMER(c, is_cancelled)
 #define SCOPED_RAW_TIMER(c)
 #define COUNTER_UPDATE(c, v)
 #define COUNTER_SET(c, v)
 #define COUNTER_ADD(c, v)
-#define ADD_THREADCOUNTERS(profile, prefix) NULL
+#define ADD_THREAD_COUNTERS(profile, prefix) NULL
 #define SCOPED_THREAD_COUNTER_MEASUREMENT(c)
 #endif
 
@@ -134,7 +159,10 @@ public:
     inline static const std::string MERGED_INFO_PREFIX_MIN = "__MIN_OF_";
     inline static const std::string MERGED_INFO_PREFIX_MAX = "__MAX_OF_";
 
-    class Counter {
+    // cache-line aligned: counters are allocated back to back from the object
+    // pool and hammered from different threads, so two counters sharing a line
+    // would ping-pong it between cores on every update
+    class ALIGN_CACHE_LINE Counter {
     public:
         static TCounterStrategy create_strategy(
                 TCounterAggregateType::type aggregate_type,
@@ -157,21 +185,27 @@ public:
         }
 
         explicit Counter(TUnit::type type, int64_t value = 0)
-                : _value(0), _type(type), _strategy(create_strategy(type)) {}
+                : _value(0), _type(type), _strategy(create_strategy(type)), _flags(compute_flags(_strategy)) {}
         explicit Counter(TUnit::type type, const TCounterStrategy& strategy, int64_t value = 0)
-                : _value(value), _type(type), _strategy(strategy) {}
+                : _value(value), _type(type), _strategy(strategy), _flags(compute_flags(_strategy)) {}
 
         virtual ~Counter() = default;
 
-        virtual void update(int64_t delta) { _value.fetch_add(delta, std::memory_order_relaxed); }
+        // note: profile counters are deliberately a single relaxed atomic, not
+        // per-core shards; nearly all of them are updated by one pipeline
+        // driver at a time, so sharding would multiply the footprint of every
+        // counter for no win. For process-wide counters hammered from many
+        // threads use CoreLocalCounter (util/metrics.h) instead.
+        // Non-virtual: no subclass overrides it, and the scoped timers call it
+        // through a plain Counter*, so keeping it virtual would force an
+        // indirect call on every scope exit.
+        void update(int64_t delta) { _value.fetch_add(delta, std::memory_order_relaxed); }
 
         // Use this to update if the counter is a bitmap
         void bit_or(int64_t delta) {
-            int64_t old;
-            do {
-                old = _value.load(std::memory_order_relaxed);
-                if (LIKELY((old | delta) == old)) return; // Bits already set, avoid atomic.
-            } while (UNLIKELY(!_value.compare_exchange_strong(old, old | delta, std::memory_order_relaxed)));
+            int64_t old = _value.load(std::memory_order_relaxed);
+            if (LIKELY((old | delta) == old)) return; // Bits already set, avoid atomic.
+            _value.fetch_or(delta, std::memory_order_relaxed);
         }
 
         virtual void set(int64_t value) { _value.store(value, std::memory_order_relaxed); }
@@ -182,47 +216,113 @@ public:
 
         virtual double double_value() const { return bit_cast<double>(_value.load(std::memory_order_relaxed)); }
 
-        virtual void set_min(int64_t min) { _min_value.emplace(min); }
-        virtual void set_max(int64_t max) { _max_value.emplace(max); }
-        virtual std::optional<int64_t> min_value() const { return _min_value; }
-        virtual std::optional<int64_t> max_value() const { return _max_value; }
+        virtual void set_min(int64_t min) {
+            ColdData* cold = _cold();
+            cold->min_value = min;
+            cold->has_min = true;
+        }
+        virtual void set_max(int64_t max) {
+            ColdData* cold = _cold();
+            cold->max_value = max;
+            cold->has_max = true;
+        }
+        virtual std::optional<int64_t> min_value() const {
+            if (_cold_data == nullptr || !_cold_data->has_min) {
+                return std::nullopt;
+            }
+            return _cold_data->min_value;
+        }
+        virtual std::optional<int64_t> max_value() const {
+            if (_cold_data == nullptr || !_cold_data->has_max) {
+                return std::nullopt;
+            }
+            return _cold_data->max_value;
+        }
 
         TUnit::type type() const { return _type; }
 
         const TCounterStrategy& strategy() const { return _strategy; }
 
-        bool is_sum() const {
-            return _strategy.aggregate_type == TCounterAggregateType::SUM ||
-                   _strategy.aggregate_type == TCounterAggregateType::SUM_AVG;
-        }
-        bool is_avg() const {
-            return _strategy.aggregate_type == TCounterAggregateType::AVG ||
-                   _strategy.aggregate_type == TCounterAggregateType::AVG_SUM;
-        }
+        // The strategy predicates below are queried repeatedly in merge and
+        // pretty_print loops; the answers never change after construction, so
+        // they are precomputed into _flags and tested with a single bit AND.
+        bool is_sum() const { return _flags & kIsSum; }
+        bool is_avg() const { return _flags & kIsAvg; }
 
-        bool skip_merge() const {
-            return _strategy.merge_type == TCounterMergeType::SKIP_ALL ||
-                   _strategy.merge_type == TCounterMergeType::SKIP_FIRST_MERGE;
-        }
+        bool skip_merge() const { return _flags & kSkipMerge; }
 
-        bool skip_min_max() const { return _strategy.min_max_type == TCounterMinMaxType::SKIP_ALL; }
+        bool skip_min_max() const { return _flags & kSkipMinMax; }
 
         int64_t display_threshold() const { return _strategy.display_threshold; }
-        bool should_display() const {
-            int64_t threshold = _strategy.display_threshold;
-            return threshold == 0 || value() > threshold;
-        }
+        bool should_display() const { return (_flags & kAlwaysDisplay) || value() > _strategy.display_threshold; }
 
     private:
         friend class RuntimeProfile;
 
+        enum Flags : uint8_t {
+            kIsSum = 1 << 0,
+            kIsAvg = 1 << 1,
+            kSkipMerge = 1 << 2,
+            kSkipMinMax = 1 << 3,
+            kAlwaysDisplay = 1 << 4,
+        };
+
+        static uint8_t compute_flags(const TCounterStrategy& strategy) {
+            uint8_t flags = 0;
+            if (strategy.aggregate_type == TCounterAggregateType::SUM ||
+                strategy.aggregate_type == TCounterAggregateType::SUM_AVG) {
+                flags |= kIsSum;
+            }
+            if (strategy.aggregate_type == TCounterAggregateType::AVG ||
+                strategy.aggregate_type == TCounterAggregateType::AVG_SUM) {
+                flags |= kIsAvg;
+            }
+            if (strategy.merge_type == TCounterMergeType::SKIP_ALL ||
+                strategy.merge_type == TCounterMergeType::SKIP_FIRST_MERGE) {
+                flags |= kSkipMerge;
+            }
+            if (strategy.min_max_type == TCounterMinMaxType::SKIP_ALL) {
+                flags |= kSkipMinMax;
+            }
+            if (strategy.display_threshold == 0) {
+                flags |= kAlwaysDisplay;
+            }
+            return flags;
+        }
+
+        // min/max are only touched when profiles are merged or serialized;
+        // keeping them behind a lazily allocated block shrinks the part of the
+        // counter that the per-row update path drags into cache
+        // raw values plus presence flags: two std::optional<int64_t> would be
+        // 32 bytes for the same information
+        struct ColdData {
+            int64_t min_value = 0;
+            int64_t max_value = 0;
+            bool has_min = false;
+            bool has_max = false;
+        };
+
+        ColdData* _cold() {
+            if (_cold_data == nullptr) {
+                _cold_data = std::make_unique<ColdData>();
+            }
+            return _cold_data.get();
+        }
+
         std::atomic<int64_t> _value;
         const TUnit::type _type;
         const TCounterStrategy _strategy;
-        std::optional<int64_t> _min_value;
-        std::optional<int64_t> _max_value;
+        // precomputed from _strategy, see compute_flags()
+        const uint8_t _flags;
+        std::unique_ptr<ColdData> _cold_data;
     };
 
+    static_assert(alignof(Counter) == CACHE_LINE_SIZE);
+    // every live field a concurrent reader can observe is a single lock-free
+    // word; multi-word snapshot schemes (seqlock etc.) are only needed if a
+    // counter ever grows coupled state read outside _counter_lock
+    static_assert(std::atomic<int64_t>::is_always_lock_free);
+
     class ConcurrentTimerCounter;
     class DerivedCounter;
     class EventSequence;
@@ -232,8 +332,10 @@ public:
 
     /// A counter that keeps track of the highest/lowest value seen (reporting that
     /// as value()) and the current value.
+    // final: lets calls through a concrete WaterMarkCounter*/DerivedCounter*
+    // pointer be devirtualized and the relaxed atomic load inlined
     template <bool is_high>
-    class WaterMarkCounter : public Counter {
+    class WaterMarkCounter final : public Counter {
     public:
         explicit WaterMarkCounter(TUnit::type type, int64_t value = 0) : Counter(type, value) { _set_init_value(); }
         explicit WaterMarkCounter(TUnit::type type, const TCounterStrategy& strategy, int64_t value = 0)
@@ -279,18 +381,17 @@ public:
         }
 
         /// Set '_value' to 'v' if 'v' is larger/lower than '_value'. The entire operation is
-        /// atomic.
+        /// atomic. (fetch_max/fetch_min only arrive with C++26; until then a weak CAS,
+        /// which refreshes the expected value on failure, is the cheapest retry loop.)
         void Update(int64_t v) {
+            int64_t old_value = _value.load(std::memory_order_relaxed);
             while (true) {
-                int64_t old_value = _value.load(std::memory_order_relaxed);
-                int64_t new_value;
                 if constexpr (is_high) {
-                    new_value = std::max(old_value, v);
+                    if (old_value >= v) break; // Avoid atomic update.
                 } else {
-                    new_value = std::min(old_value, v);
+                    if (old_value <= v) break; // Avoid atomic update.
                 }
-                if (new_value == old_value) break; // Avoid atomic update.
-                if (LIKELY(_value.compare_exchange_strong(old_value, new_value, std::memory_order_relaxed))) break;
+                if (LIKELY(_value.compare_exchange_weak(old_value, v, std::memory_order_relaxed))) break;
             }
         }
 
@@ -303,11 +404,16 @@ public:
     using HighWaterMarkCounter = WaterMarkCounter<true>;
     using LowWaterMarkCounter = WaterMarkCounter<false>;
 
+    // Every derived counter in the tree captures two Counter* (see the
+    // units_per_second call sites), which fits std::function's inline buffer
+    // on our toolchains — no heap allocation, one indirect call on read-only
+    // paths. Replacing it with a tagged (op, lhs, rhs) struct is not worth
+    // losing the open interface for that.
     typedef std::function<int64_t()> DerivedCounterFunction;
 
     // A DerivedCounter also has a name and type, but the value is computed.
     // Do not call Set() and Update().
-    class DerivedCounter : public Counter {
+    class DerivedCounter final : public Counter {
     public:
         DerivedCounter(TUnit::type type, DerivedCounterFunction counter_fn)
                 : Counter(type, create_strategy(type), 0), _counter_fn(std::move(counter_fn)) {}
@@ -356,7 +462,14 @@ public:
         // Stores an event in sequence with the given label and the
         // current time (relative to the first time start() was called) as
         // the timestamp.
-        void mark_event(const std::string& label) { _events.push_back(make_pair(label, _sw.elapsed_time())); }
+        void mark_event(std::string label) {
+            // reserve once on first use instead of in the constructor: many
+            // sequences are created but never marked
+            if (_events.empty()) {
+                _events.reserve(16);
+            }
+            _events.emplace_back(std::move(label), _sw.elapsed_time());
+        }
 
         int64_t elapsed_time() { return _sw.elapsed_time(); }
 
@@ -447,8 +560,8 @@ public:
     // If parent_name is a non-empty string, the counter is added as a child of
     // parent_name.
     // Returns NULL if the counter already exists.
-    DerivedCounter* add_derived_counter(const std::string& name, TUnit::type type,
-                                        const DerivedCounterFunction& counter_fn, const std::string& parent_name);
+    DerivedCounter* add_derived_counter(const std::string& name, TUnit::type type, DerivedCounterFunction counter_fn,
+                                        const std::string& parent_name);
 
     // Add a set of thread counters prefixed with 'prefix'. Returns a ThreadCounters object
     // that the caller can update.  The counter is owned by the RuntimeProfile object.
@@ -564,15 +677,9 @@ public:
     // This function updates _local_time_percent for each profile.
     void compute_time_in_profile();
 
-    void inc_version() {
-        std::lock_guard<std::mutex> l(_version_lock);
-        _version += 1;
-    }
+    void inc_version() { _version.fetch_add(1, std::memory_order_relaxed); }
 
-    int64_t get_version() const {
-        std::lock_guard<std::mutex> l(_version_lock);
-        return _version;
-    }
+    int64_t get_version() const { return _version.load(std::memory_order_relaxed); }
 
 public:
     // The root counter name for all top level counters.
@@ -594,6 +701,17 @@ private:
     // object, but occasionally allocated in the constructor.
     std::unique_ptr<ObjectPool> _pool;
 
+    // Plain counters and event sequences are bump-allocated from these deques
+    // instead of one heap allocation each through _pool, so they end up packed
+    // into a few contiguous blocks. A deque never relocates existing elements
+    // when it grows, so the Counter*/EventSequence* handed out stay valid.
+    // Polymorphic counter types (watermark, derived) still go through _pool.
+    // Counter names are not pooled here: they live as map keys whose lifetime
+    // the maps already manage, and pooling them would tie key storage to a
+    // second owner for no allocation saving on the update path.
+    std::deque<Counter> _counter_arena;
+    std::deque<EventSequence> _event_sequence_arena;
+
     // Name for this runtime profile.
     std::string _name;
 
@@ -606,24 +724,30 @@ private:
 
     // Map from counter names to counters and parent counter names.
     // The profile owns the memory for the counters.
-    typedef std::map<std::string, std::pair<Counter*, std::string>> CounterMap;
+    // Hash map: counter lookups dominate and no code relies on name order
+    // (printing is driven by the sorted _child_counter_map).
+    typedef phmap::flat_hash_map<std::string, std::pair<Counter*, std::string>> CounterMap;
     CounterMap _counter_map;
 
-    // Map from parent counter name to a set of child counter name.
+    // Map from parent counter name to the sorted names of its child counters.
     // All top level counters are the child of "" (root).
-    typedef std::map<std::string, std::set<std::string>> ChildCounterMap;
+    // Child lists typically hold a handful of names, so a sorted vector beats
+    // a std::set node per name; to_thrift converts back to the thrift shape.
+    typedef std::map<std::string, std::vector<std::string>> ChildCounterMap;
     ChildCounterMap _child_counter_map;
 
     // A set of bucket counters registered in this runtime profile.
     std::set<std::vector<Counter*>*> _bucketing_counters;
 
-    // protects _counter_map, _counter_child_map and _bucketing_counters
-    mutable std::mutex _counter_lock;
+    // protects _counter_map, _counter_child_map and _bucketing_counters.
+    // Lookups (get_counter and friends) vastly outnumber registrations, so a
+    // shared_mutex lets concurrent readers proceed without serializing.
+    mutable std::shared_mutex _counter_lock;
 
     // Child profiles.  Does not own memory.
-    // We record children in both a map (to facilitate updates) and a vector
-    // (to print things in the order they were registered)
-    typedef std::map<std::string, RuntimeProfile*> ChildMap;
+    // _children is the single source of ordering (registration order);
+    // _child_map is only a name index into it, so a hash map suffices.
+    typedef phmap::flat_hash_map<std::string, RuntimeProfile*> ChildMap;
     ChildMap _child_map;
 
     ChildVector _children;
@@ -637,7 +761,7 @@ private:
     InfoStringsDisplayOrder _info_strings_display_order;
 
     // Protects _info_strings and _info_strings_display_order
-    mutable std::mutex _info_strings_lock;
+    mutable std::shared_mutex _info_strings_lock;
 
     typedef std::map<std::string, EventSequence*> EventSequenceMap;
     EventSequenceMap _event_sequence_map;
@@ -648,11 +772,9 @@ private:
     // of the total time in the entire profile tree.
     double _local_time_percent;
 
-    // Protects _version
-    mutable std::mutex _version_lock;
     // The version of this profile. It is used to prevent updating this profile
     // from an old one.
-    int64_t _version{0};
+    std::atomic<int64_t> _version{0};
 
     // update a subtree of profiles from nodes, rooted at *idx. If the version
     // of the parent node, or the version of root node for this subtree is older,
@@ -684,9 +806,13 @@ private:
     typedef std::tuple<int64_t, int64_t, int64_t> MergedInfo;
     static MergedInfo merge_isomorphic_counters(std::vector<Counter*>& counters);
 
-    static bool is_time_type(TUnit::type type) {
-        return TUnit::type::CPU_TICKS == type || TUnit::type::TIME_NS == type || TUnit::type::TIME_MS == type ||
-               TUnit::type::TIME_S == type;
+    static constexpr bool is_time_type(TUnit::type type) {
+        // one shift+and instead of a four-way compare chain; checked on every
+        // counter emit and merge decision
+        constexpr uint64_t time_type_mask = (1ULL << TUnit::type::CPU_TICKS) | (1ULL << TUnit::type::TIME_NS) |
+                                            (1ULL << TUnit::type::TIME_MS) | (1ULL << TUnit::type::TIME_S);
+        static_assert(TUnit::type::CPU_TICKS < 64 && TUnit::type::TIME_S < 64, "TUnit no longer fits the bitmask");
+        return (time_type_mask >> static_cast<unsigned>(type)) & 1u;
     }
 
     std::string get_children_name_string();
@@ -695,10 +821,18 @@ private:
 // Utility class to update the counter at object construction and destruction.
 // When the object is constructed, decrement the counter by val.
 // When the object goes out of scope, increment the counter by val.
+//
+// The scoped helpers below write straight to the shared counter. Per-thread
+// delta shards merged at report time were considered for this sink path and
+// rejected: profile counters belong to a single pipeline driver (see
+// Counter::update), so there is no cross-core ping-pong to amortize, and a
+// shard lookup would add work to every scope exit.
 class ScopedCounter {
 public:
     ScopedCounter(RuntimeProfile::Counter* counter, int64_t val) : _val(val), _counter(counter) {
-        if (counter == nullptr) {
+        // a null counter only occurs when a caller's profile is disabled,
+        // so steer prediction and code layout toward the counting path
+        if (UNLIKELY(counter == nullptr)) {
             return;
         }
 
@@ -707,7 +841,7 @@ public:
 
     // Increment the counter when object is destroyed
     ~ScopedCounter() {
-        if (_counter != nullptr) {
+        if (LIKELY(_counter != nullptr)) {
             _counter->update(_val);
         }
     }
@@ -724,11 +858,18 @@ private:
 // Utility class to update time elapsed when the object goes out of scope.
 // 'T' must implement the stopWatch "interface" (start,stop,elapsed_time) but
 // we use templates not to pay for virtual function overhead.
-template <class T>
+// 'cancel_safe' timers additionally watch a cancellation flag and drop their
+// measurement once it is set; almost no instantiation needs that, so the flag
+// pointer and its check only exist when the parameter says so.
+template <class T, bool cancel_safe = false>
 class ScopedTimer {
 public:
-    explicit ScopedTimer(RuntimeProfile::Counter* counter, const bool* is_cancelled = nullptr)
-            : _counter(counter), _is_cancelled(is_cancelled) {
+    explicit ScopedTimer(RuntimeProfile::Counter* counter, const bool* is_cancelled = nullptr) : _counter(counter) {
+        if constexpr (cancel_safe) {
+            _is_cancelled = is_cancelled;
+        } else {
+            DCHECK(is_cancelled == nullptr);
+        }
         if (counter == nullptr) {
             return;
         }
@@ -736,6 +877,11 @@ public:
         _sw.start();
     }
 
+    // For call sites where the counter is statically known to be absent:
+    // nothing is checked or started, so the whole object folds to nothing
+    // after inlining.
+    explicit ScopedTimer(std::nullptr_t) : _counter(nullptr) {}
+
     // Disable copy constructor and assignment
     ScopedTimer(const ScopedTimer& timer) = delete;
     ScopedTimer& operator=(const ScopedTimer& timer) = delete;
@@ -746,7 +892,13 @@ public:
 
     int64_t elapsed_time() { return _sw.elapsed_time(); }
 
-    bool is_cancelled() { return _is_cancelled != nullptr && *_is_cancelled; }
+    bool is_cancelled() {
+        if constexpr (cancel_safe) {
+            return _is_cancelled != nullptr && *_is_cancelled;
+        } else {
+            return false;
+        }
+    }
 
     void UpdateCounter() {
         if (_counter != nullptr && !is_cancelled()) {
@@ -754,16 +906,29 @@ public:
         }
     }
 
-    // Update counter when object is destroyed
+    // Update counter when object is destroyed.
+    // Deliberately one immediate relaxed add rather than a thread-local ring
+    // of deferred <counter, delta> entries: timers wrap whole get_next/open
+    // calls, not per-row work, so there are too few destructions per counter
+    // to amortize, and deferral would leave time invisible to the profile
+    // reporter until some later flush.
     ~ScopedTimer() {
+        // without a counter nothing consumes the measurement, so don't pay
+        // the clock_gettime in stop(); an explicit stop() before destruction
+        // is already absorbed by the stopwatch's running flag
+        if (_counter == nullptr) {
+            return;
+        }
         _sw.stop();
         UpdateCounter();
     }
 
 private:
+    struct NoCancelFlag {};
+
     T _sw;
     RuntimeProfile::Counter* _counter;
-    const bool* _is_cancelled;
+    [[no_unique_address]] std::conditional_t<cancel_safe, const bool*, NoCancelFlag> _is_cancelled{};
 };
 
 // Utility class to update time elapsed when the object goes out of scope.
@@ -773,8 +938,10 @@ template <class T>
 class ScopedRawTimer {
 public:
     explicit ScopedRawTimer(int64_t* counter) : _counter(counter) { _sw.start(); }
-    // Update counter when object is destroyed
-    ~ScopedRawTimer() { *_counter += _sw.elapsed_time(); }
+    // Update counter when object is destroyed. Force-inlined so that
+    // back-to-back raw-timed scopes in one function share the counter
+    // address computation instead of going through an outlined destructor.
+    ALWAYS_INLINE ~ScopedRawTimer() { *_counter += _sw.elapsed_time(); }
 
     // Disable copy constructor and assignment
     ScopedRawTimer(const ScopedRawTimer& timer) = delete;